@@ -0,0 +1,33 @@
+#include "Bench.hpp"
+#include <new>
+#include <cstdlib>
+
+// Replaces the global operator new/delete so the bench binaries can count
+// heap traffic. The array forms forward here in libstdc++ and libc++.
+
+static unsigned long g_allocCount = 0;
+static unsigned long g_allocBytes = 0;
+
+namespace bench {
+
+unsigned long allocCount() { return g_allocCount; }
+unsigned long allocBytes() { return g_allocBytes; }
+
+void resetAllocStats() {
+    g_allocCount = 0;
+    g_allocBytes = 0;
+}
+
+}
+
+void* operator new(std::size_t size) throw(std::bad_alloc) {
+    ++g_allocCount;
+    g_allocBytes += size;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw() {
+    std::free(p);
+}
@@ -0,0 +1,454 @@
+#include "Bench.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <limits>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <time.h>
+#include <sys/resource.h>
+#ifdef __GLIBC__
+# include <malloc.h>
+#endif
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/syscall.h>
+# include <sys/ioctl.h>
+# include <unistd.h>
+# include <stdint.h>
+#endif
+
+namespace bench {
+
+// ---------- Clock / process ----------
+double nowUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line); )
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::strtol(line.c_str() + 6, 0, 10);
+
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+    return ru.ru_maxrss; // kilobytes on Linux
+}
+
+bool resetPeakRss() {
+#ifdef __GLIBC__
+    malloc_trim(0); // hand back what earlier cases freed so it is not counted
+#endif
+    // "5" resets the VmHWM high-water mark (Linux 4.0+)
+    std::ofstream out("/proc/self/clear_refs");
+    if (!out) return false;
+    out << '5';
+    out.close();
+    return !out.fail();
+}
+
+ScopedTimer::ScopedTimer(double& sinkUs) : _sink(sinkUs), _start(nowUs()) {}
+ScopedTimer::~ScopedTimer() { _sink += nowUs() - _start; }
+
+// ---------- Hardware counters ----------
+#ifdef __linux__
+// groupFd < 0 opens a (disabled) group leader; members follow its state
+static int openCounter(unsigned long config, int groupFd) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = groupFd < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                     | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+#endif
+
+PerfCounters::PerfCounters() : _leader(-1) {
+    for (int i = 0; i < kCount; ++i) _fd[i] = -1;
+#ifdef __linux__
+    static const unsigned long configs[kCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    for (int i = 0; i < kCount; ++i) {
+        _fd[i] = openCounter(configs[i], _leader);
+        if (_leader < 0) _leader = _fd[i];
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int i = 0; i < kCount; ++i)
+        if (_fd[i] >= 0) close(_fd[i]);
+#endif
+}
+
+bool PerfCounters::available() const { return _leader >= 0; }
+
+void PerfCounters::start() {
+#ifdef __linux__
+    if (_leader < 0) return;
+    ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+PerfSample PerfCounters::stop() {
+    long v[kCount];
+    for (int i = 0; i < kCount; ++i) v[i] = -1;
+#ifdef __linux__
+    if (_leader >= 0) {
+        ioctl(_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // { nr, time_enabled, time_running, value[nr] }, values in the
+        // order the events joined the group, i.e. the open ones in _fd order
+        uint64_t buf[3 + kCount];
+        ssize_t got = read(_leader, buf, sizeof(buf));
+        if (got >= static_cast<ssize_t>(3 * sizeof(uint64_t)) && buf[2] > 0) {
+            double scale = static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+            size_t slot = 0;
+            for (int i = 0; i < kCount && slot < buf[0]; ++i) {
+                if (_fd[i] < 0) continue;
+                v[i] = static_cast<long>(static_cast<double>(buf[3 + slot]) * scale);
+                ++slot;
+            }
+        }
+    }
+#endif
+    PerfSample s;
+    s.cycles = v[0];
+    s.instructions = v[1];
+    s.cacheMisses = v[2];
+    s.branchMisses = v[3];
+    return s;
+}
+
+// ---------- stdout silencing ----------
+SilenceStdout::SilenceStdout() : _saved(std::cout.rdbuf(&_null)) {}
+SilenceStdout::~SilenceStdout() { std::cout.rdbuf(_saved); }
+
+// ---------- Options ----------
+Options defaultOptions() {
+    Options o;
+    o.reps = 5;
+    o.warmup = 1;
+    o.minSampleUs = 1000.0;
+    o.format = "csv";
+    o.threshold = 10.0;
+    o.compareOnly = false;
+    return o;
+}
+
+static double parseNumber(const std::string& flag, const std::string& s) {
+    char* end = 0;
+    double v = std::strtod(s.c_str(), &end);
+    if (s.empty() || *end != '\0' || v < 0)
+        throw std::runtime_error("bad value for " + flag + ": " + s);
+    return v;
+}
+
+unsigned long parseUnsigned(const std::string& flag, const std::string& s,
+                            unsigned long lo, unsigned long hi) {
+    char* end = 0;
+    errno = 0;
+    unsigned long v = std::strtoul(s.c_str(), &end, 10);
+    if (s.empty() || *end != '\0' || !std::isdigit(static_cast<unsigned char>(s[0])) || errno == ERANGE)
+        throw std::runtime_error("bad value for " + flag + ": " + s);
+    if (v < lo || v > hi) {
+        std::ostringstream oss;
+        oss << flag << " must be in [" << lo << ", " << hi << "]";
+        throw std::runtime_error(oss.str());
+    }
+    return v;
+}
+
+bool parseCommonFlag(Options& o, const std::string& flag, const std::string& val) {
+    if (flag == "--reps") o.reps = static_cast<int>(parseUnsigned(flag, val, 1, 1000000));
+    else if (flag == "--warmup") o.warmup = static_cast<int>(parseUnsigned(flag, val, 0, 1000000));
+    else if (flag == "--min-sample-us") o.minSampleUs = parseNumber(flag, val);
+    else if (flag == "--format") {
+        if (val != "csv" && val != "json")
+            throw std::runtime_error("--format must be csv or json");
+        o.format = val;
+    }
+    else if (flag == "--baseline") {
+        o.baseline = val;
+        o.compareOnly = false;
+    }
+    else if (flag == "--compare") {
+        o.baseline = val;
+        o.compareOnly = true;
+    }
+    else if (flag == "--threshold") o.threshold = parseNumber(flag, val);
+    else return false;
+    return true;
+}
+
+std::string commonUsage() {
+    return "[--reps N] [--warmup N] [--min-sample-us US] [--format csv|json]"
+           " [--baseline file.csv] [--threshold pct] [--compare file.csv]";
+}
+
+// ---------- Measurement ----------
+// nearest-rank percentile over an already sorted sample
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1];
+}
+
+// Number of run() calls that makes one sample last at least o.minSampleUs;
+// single calls of the short cases are mostly clock overhead and noise.
+static unsigned long calibrate(Body& body, const Options& o) {
+    static const unsigned long kMaxIterations = 1000000000UL;
+    unsigned long iters = 1;
+    for (;;) {
+        double elapsed = 0;
+        body.setup();
+        {
+            ScopedTimer t(elapsed);
+            for (unsigned long k = 0; k < iters; ++k) body.run();
+        }
+        body.teardown();
+        if (elapsed >= o.minSampleUs || iters >= kMaxIterations) return iters;
+
+        // aim a little past the target, growing at most 10x per round
+        double scale = elapsed > 0 ? 1.2 * o.minSampleUs / elapsed : 10.0;
+        if (scale > 10.0) scale = 10.0;
+        unsigned long next = static_cast<unsigned long>(iters * scale);
+        iters = next > iters ? next : iters + 1;
+    }
+}
+
+static long perIteration(long v, unsigned long iters) {
+    return v < 0 ? v : static_cast<long>(v / static_cast<long>(iters));
+}
+
+Result measure(const std::string& name, Body& body, const Options& o) {
+    // without a reset the peak would be that of every case run so far
+    bool isolatedRss = resetPeakRss();
+    PerfCounters perf;
+    for (int i = 0; i < o.warmup; ++i) {
+        body.setup();
+        body.run();
+        body.teardown();
+    }
+
+    Result r;
+    r.name = name;
+    r.reps = o.reps;
+    r.iterations = calibrate(body, o);
+
+    std::vector<double> samples;
+    samples.reserve(o.reps);
+    for (int i = 0; i < o.reps; ++i) {
+        body.setup();
+        double elapsed = 0;
+        resetAllocStats();
+        perf.start();
+        {
+            ScopedTimer t(elapsed);
+            for (unsigned long k = 0; k < r.iterations; ++k) body.run();
+        }
+        r.perf = perf.stop();
+        r.allocs = allocCount() / r.iterations;
+        r.allocBytes = allocBytes() / r.iterations;
+        body.teardown();
+        samples.push_back(elapsed / r.iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    r.perf.cycles = perIteration(r.perf.cycles, r.iterations);
+    r.perf.instructions = perIteration(r.perf.instructions, r.iterations);
+    r.perf.cacheMisses = perIteration(r.perf.cacheMisses, r.iterations);
+    r.perf.branchMisses = perIteration(r.perf.branchMisses, r.iterations);
+
+    r.minUs = samples.front();
+    r.medianUs = (samples.size() % 2) ? samples[samples.size() / 2]
+               : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2.0;
+    r.p95Us = percentile(samples, 0.95);
+    r.peakRssKb = isolatedRss ? peakRssKb() : -1;
+    return r;
+}
+
+// ---------- Reporting ----------
+Reporter::Reporter(const Options& o, const std::vector<std::string>& extraColumns)
+    : _opt(o), _extra(extraColumns) {}
+
+void Reporter::begin() {
+    std::cout.setf(std::ios::fixed);
+    std::cout << std::setprecision(3);
+    if (_opt.format == "json") {
+        std::cout << "[\n";
+        return;
+    }
+    std::cout << "name,reps,iters,min_us,median_us,p95_us,allocs,alloc_bytes,"
+                 "cycles,instructions,cache_misses,branch_misses,peak_rss_kb";
+    for (size_t i = 0; i < _extra.size(); ++i) std::cout << ',' << _extra[i];
+    std::cout << '\n';
+}
+
+double noValue() { return std::numeric_limits<double>::quiet_NaN(); }
+
+// counts are stored as doubles; keep them free of a ".000" suffix
+static void printExtra(double v, bool json) {
+    if (v != v) {
+        if (json) std::cout << "null";
+    }
+    else if (v == static_cast<double>(static_cast<long>(v))) std::cout << static_cast<long>(v);
+    else std::cout << v;
+}
+
+void Reporter::add(const Result& r) {
+    if (_opt.format == "csv") {
+        std::cout << r.name << ',' << r.reps << ',' << r.iterations << ',' << r.minUs << ',' << r.medianUs << ','
+                  << r.p95Us << ',' << r.allocs << ',' << r.allocBytes << ','
+                  << r.perf.cycles << ',' << r.perf.instructions << ','
+                  << r.perf.cacheMisses << ',' << r.perf.branchMisses << ',' << r.peakRssKb;
+        for (size_t i = 0; i < _extra.size() && i < r.extra.size(); ++i) {
+            std::cout << ',';
+            printExtra(r.extra[i], false);
+        }
+        std::cout << '\n';
+    }
+    else {
+        std::cout << (_results.empty() ? "  " : ",\n  ")
+                  << "{\"name\": \"" << r.name << "\", \"reps\": " << r.reps
+                  << ", \"iters\": " << r.iterations
+                  << ", \"min_us\": " << r.minUs << ", \"median_us\": " << r.medianUs
+                  << ", \"p95_us\": " << r.p95Us << ", \"allocs\": " << r.allocs
+                  << ", \"alloc_bytes\": " << r.allocBytes
+                  << ", \"cycles\": " << r.perf.cycles
+                  << ", \"instructions\": " << r.perf.instructions
+                  << ", \"cache_misses\": " << r.perf.cacheMisses
+                  << ", \"branch_misses\": " << r.perf.branchMisses
+                  << ", \"peak_rss_kb\": " << r.peakRssKb;
+        for (size_t i = 0; i < _extra.size() && i < r.extra.size(); ++i) {
+            std::cout << ", \"" << _extra[i] << "\": ";
+            printExtra(r.extra[i], true);
+        }
+        std::cout << "}";
+    }
+    std::cout.flush();
+    _results.push_back(r);
+}
+
+struct BaselineEntry {
+    double medianUs;
+    long allocs;    // -1 when the baseline has no allocs column
+};
+
+// name -> median_us/allocs from a CSV written by a previous run
+static std::map<std::string, BaselineEntry> loadBaseline(const std::string& path) {
+    std::ifstream in(path.c_str());
+    if (!in) throw std::runtime_error("could not open baseline " + path);
+
+    std::map<std::string, BaselineEntry> out;
+    std::string line;
+    if (!std::getline(in, line)) return out;
+
+    int nameCol = -1, medianCol = -1, allocsCol = -1, col = 0;
+    std::istringstream header(line);
+    for (std::string field; std::getline(header, field, ','); ++col) {
+        if (field == "name") nameCol = col;
+        if (field == "median_us") medianCol = col;
+        if (field == "allocs") allocsCol = col;
+    }
+    if (nameCol < 0 || medianCol < 0)
+        throw std::runtime_error("baseline " + path + " has no name/median_us columns");
+
+    while (std::getline(in, line)) {
+        std::istringstream row(line);
+        std::string field, name;
+        BaselineEntry e;
+        e.medianUs = -1;
+        e.allocs = -1;
+        col = 0;
+        for (; std::getline(row, field, ','); ++col) {
+            if (col == nameCol) name = field;
+            if (col == medianCol) e.medianUs = std::strtod(field.c_str(), 0);
+            if (col == allocsCol) e.allocs = std::strtol(field.c_str(), 0, 10);
+        }
+        if (!name.empty() && e.medianUs >= 0) out[name] = e;
+    }
+    return out;
+}
+
+int Reporter::end() {
+    if (_opt.format == "json") std::cout << "\n]\n";
+    if (_opt.baseline.empty()) return 0;
+
+    std::map<std::string, BaselineEntry> base = loadBaseline(_opt.baseline);
+    int regressions = 0;
+    std::cerr.setf(std::ios::fixed);
+    std::cerr << std::setprecision(2);
+    for (size_t i = 0; i < _results.size(); ++i) {
+        const Result& r = _results[i];
+        std::map<std::string, BaselineEntry>::const_iterator it = base.find(r.name);
+        if (it == base.end() || it->second.medianUs <= 0 || r.medianUs <= 0) continue;
+
+        const BaselineEntry& b = it->second;
+        bool regressed = !_opt.compareOnly
+                      && r.medianUs > b.medianUs * (1.0 + _opt.threshold / 100.0);
+        if (regressed) ++regressions;
+        if (!_opt.compareOnly)
+            std::cerr << (regressed ? "REGRESSION " : "ok         ");
+        std::cerr << r.name
+                  << ": " << r.medianUs << " us vs " << b.medianUs << " us ("
+                  << b.medianUs / r.medianUs << "x)";
+        if (b.allocs >= 0)
+            std::cerr << ", allocs " << r.allocs << " vs " << b.allocs;
+        std::cerr << '\n';
+    }
+    if (regressions)
+        std::cerr << regressions << " case(s) slower than baseline by more than "
+                  << _opt.threshold << "%\n";
+    return regressions ? 1 : 0;
+}
+
+// ---------- Driver ----------
+int runMain(Driver& d, int argc, char** argv) {
+    Options o = defaultOptions();
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string flag = argv[i];
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + flag);
+            std::string val = argv[++i];
+            if (!d.parseFlag(flag, val) && !parseCommonFlag(o, flag, val))
+                throw std::runtime_error("unknown flag " + flag);
+        }
+        d.finishOptions();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n'
+                  << "usage: " << d.name() << ' ' << d.usage() << ' ' << commonUsage() << '\n';
+        return 1;
+    }
+
+    Reporter rep(o, d.extraColumns());
+    try {
+        rep.begin();
+        d.run(rep, o);
+        return rep.end();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
+
+}
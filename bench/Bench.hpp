@@ -0,0 +1,183 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <string>
+#include <vector>
+#include <streambuf>
+#include <climits>
+
+// Shared benchmark layer for the btc, RPN and PmergeMe bench binaries.
+// Only linked into the *_bench targets, never into the graded programs.
+namespace bench {
+
+// ---------- Clock / process ----------
+double nowUs();          // CLOCK_MONOTONIC, microseconds
+// Peak resident set since the last successful resetPeakRss() (VmHWM), or
+// since process start (ru_maxrss) where /proc is missing; -1 if unavailable.
+long peakRssKb();
+// Lowers the peak back to the current RSS via /proc/self/clear_refs; false
+// when the kernel does not support it.
+bool resetPeakRss();
+
+// Adds the elapsed time of its scope to `sinkUs`.
+class ScopedTimer {
+    public:
+        explicit ScopedTimer(double& sinkUs);
+        ~ScopedTimer();
+
+    private:
+        double& _sink;
+        double _start;
+
+        ScopedTimer(const ScopedTimer&);
+        ScopedTimer& operator=(const ScopedTimer&);
+};
+
+// ---------- Allocation counting (AllocHook.cpp) ----------
+unsigned long allocCount();
+unsigned long allocBytes();
+void resetAllocStats();
+
+// ---------- Hardware counters ----------
+struct PerfSample {
+    long cycles;         // -1 when the counter could not be opened
+    long instructions;
+    long cacheMisses;
+    long branchMisses;
+};
+
+// Wraps perf_event_open on Linux; elsewhere, or when the kernel refuses
+// (perf_event_paranoid, containers without a PMU), every value stays -1.
+// The events form one group so they are counted over the same interval;
+// if the PMU still multiplexes the group, counts are scaled up by
+// time_enabled / time_running, and a group that never ran reports -1.
+class PerfCounters {
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        bool available() const;
+        void start();
+        PerfSample stop();
+
+    private:
+        enum { kCount = 4 };
+        int _fd[kCount];
+        int _leader;         // first event that opened, -1 if none did
+
+        PerfCounters(const PerfCounters&);
+        PerfCounters& operator=(const PerfCounters&);
+};
+
+// Swallows std::cout for the lifetime of the object (the programs under
+// test print their results, which would otherwise dominate the timings).
+class SilenceStdout {
+    public:
+        SilenceStdout();
+        ~SilenceStdout();
+
+    private:
+        class NullBuffer : public std::streambuf {
+            protected:
+                int overflow(int c) { return c; }
+        };
+        NullBuffer _null;
+        std::streambuf* _saved;
+
+        SilenceStdout(const SilenceStdout&);
+        SilenceStdout& operator=(const SilenceStdout&);
+};
+
+// ---------- Measurement ----------
+// One benchmark case. setup()/teardown() run around every sample but outside
+// the timed region; run() is what gets measured. A sample calls run() as many
+// times as it takes to last Options::minSampleUs, so run() must be safe to
+// call repeatedly between one setup() and teardown().
+class Body {
+    public:
+        virtual ~Body() {}
+        virtual void setup() {}
+        virtual void run() = 0;
+        virtual void teardown() {}
+};
+
+struct Options {
+    int reps;
+    int warmup;
+    double minSampleUs;      // calibrate run() calls per sample up to this
+    std::string format;      // csv | json
+    std::string baseline;    // CSV from a previous run, empty to skip
+    double threshold;        // allowed median slowdown vs baseline, percent
+    bool compareOnly;        // --compare: print the comparison, never fail
+};
+
+Options defaultOptions();
+// Consumes the common flags; returns false when `flag` is not one of them.
+bool parseCommonFlag(Options& o, const std::string& flag, const std::string& val);
+std::string commonUsage();
+// Decimal integer in [lo, hi]; throws a message naming `flag` otherwise.
+unsigned long parseUnsigned(const std::string& flag, const std::string& s,
+                            unsigned long lo = 0, unsigned long hi = ULONG_MAX);
+
+// Times and counts are per run() call, averaged over a sample's iterations.
+struct Result {
+    std::string name;
+    int reps;
+    unsigned long iterations;    // run() calls per sample
+    double minUs;
+    double medianUs;
+    double p95Us;
+    unsigned long allocs;        // from the last sample
+    unsigned long allocBytes;
+    PerfSample perf;             // from the last sample
+    long peakRssKb;              // peak during this case, -1 if it cannot be isolated
+    std::vector<double> extra;   // values for Reporter's extra columns
+};
+
+// Placeholder for an extra column that does not apply to a case; printed
+// as an empty CSV field / JSON null.
+double noValue();
+
+Result measure(const std::string& name, Body& body, const Options& o);
+
+// Prints results as CSV or JSON and checks them against a baseline.
+class Reporter {
+    public:
+        Reporter(const Options& o, const std::vector<std::string>& extraColumns);
+
+        void begin();
+        void add(const Result& r);
+        // Closes the output and compares medians with the baseline if one
+        // was given. Returns the process exit status (1 on regression,
+        // never with --compare).
+        int end();
+
+    private:
+        Options _opt;
+        std::vector<std::string> _extra;
+        std::vector<Result> _results;
+};
+
+// ---------- Driver ----------
+// One bench program: its own flags and the cases it runs. runMain() does
+// what every driver shares: the flag loop (driver flags first, then the
+// common ones), usage on a bad command line, the Reporter and exit status.
+class Driver {
+    public:
+        virtual ~Driver() {}
+
+        virtual const char* name() const = 0;
+        virtual std::string usage() const = 0;   // the driver's own flags
+        // Returns false when `flag` is not one of the driver's.
+        virtual bool parseFlag(const std::string& flag, const std::string& val) = 0;
+        // Called once every flag is in: defaults and cross-flag checks.
+        virtual void finishOptions() {}
+        virtual std::vector<std::string> extraColumns() const { return std::vector<std::string>(); }
+        virtual void run(Reporter& rep, const Options& o) = 0;
+};
+
+int runMain(Driver& d, int argc, char** argv);
+
+}
+
+#endif
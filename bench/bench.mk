@@ -0,0 +1,73 @@
+# Shared benchmark rules, included by each exercise Makefile after it sets
+#   BENCH        bench binary name
+#   BENCH_SRC    exercise sources (bench driver + code under test)
+#   BENCH_ARGS   arguments for `make bench`
+#
+#   make bench [VARIANT=release|debug|native|lto|pgo|stdalloc|count]   build and run one variant
+#   make bench-variants                                                  release vs lto vs pgo
+#   make bench-alloc                                                     arena/pool vs std::allocator
+#   make bench-save / bench-check                                        record / enforce a baseline
+#
+# Only the count variant compiles in comparison counting (CPP09_COUNT_CMP);
+# the others time the comparators that ship, with that column left empty.
+
+BENCH_DIR       = ../bench
+COMMON_DIR      ?= ../common
+BENCH_COMMON    = $(BENCH_DIR)/Bench.cpp $(BENCH_DIR)/AllocHook.cpp
+BENCH_DEPS      = $(BENCH_SRC) $(BENCH_COMMON) $(BENCH_DIR)/Bench.hpp $(COMMON_DIR)/Arena.hpp $(wildcard *.hpp)
+# exercises that use Arena.hpp already carry -I$(COMMON_DIR) in CC
+BENCH_CC        = $(CC) -I$(BENCH_DIR) $(if $(findstring -I$(COMMON_DIR),$(CC)),,-I$(COMMON_DIR))
+BENCH_WORK      = .bench
+
+VARIANT         ?= release
+BENCH_BASELINE  ?= bench_baseline.csv
+BENCH_THRESHOLD ?= 10
+BENCH_TRAIN_ARGS ?= $(BENCH_ARGS)
+
+FLAGS_debug     = -O0 -g
+FLAGS_release   = -O2
+FLAGS_native    = -O3 -march=native
+FLAGS_lto       = -O2 -flto
+FLAGS_stdalloc  = -O2 -DCPP09_STD_ALLOC
+FLAGS_count     = -O2 -DCPP09_COUNT_CMP
+
+$(BENCH).debug $(BENCH).release $(BENCH).native $(BENCH).lto $(BENCH).stdalloc $(BENCH).count: $(BENCH_DEPS)
+	$(BENCH_CC) $(FLAGS_$(subst $(BENCH).,,$@)) $(BENCH_SRC) $(BENCH_COMMON) -o $@
+
+# PGO: instrument, train on BENCH_TRAIN_ARGS, rebuild against the profile.
+# Both builds share one output path so gcc finds its own .gcda files.
+$(BENCH).pgo: $(BENCH_DEPS)
+	rm -rf $(BENCH_WORK)/pgo && mkdir -p $(BENCH_WORK)/pgo
+	$(BENCH_CC) -O2 -fprofile-generate $(BENCH_SRC) $(BENCH_COMMON) -o $(BENCH_WORK)/pgo/$(BENCH)
+	./$(BENCH_WORK)/pgo/$(BENCH) $(BENCH_TRAIN_ARGS) --reps 1 --warmup 0 > /dev/null
+	$(BENCH_CC) -O2 -fprofile-use -fprofile-correction $(BENCH_SRC) $(BENCH_COMMON) -o $(BENCH_WORK)/pgo/$(BENCH)
+	cp $(BENCH_WORK)/pgo/$(BENCH) $@
+
+bench: $(BENCH).$(VARIANT)
+	./$(BENCH).$(VARIANT) $(BENCH_ARGS)
+
+bench-variants: $(BENCH).release $(BENCH).lto $(BENCH).pgo $(BENCH).stdalloc $(BENCH).count
+	mkdir -p $(BENCH_WORK)
+	./$(BENCH).release $(BENCH_ARGS) > $(BENCH_WORK)/release.csv
+	@echo "== lto vs release"
+	./$(BENCH).lto $(BENCH_ARGS) --compare $(BENCH_WORK)/release.csv > $(BENCH_WORK)/lto.csv
+	@echo "== pgo vs release"
+	./$(BENCH).pgo $(BENCH_ARGS) --compare $(BENCH_WORK)/release.csv > $(BENCH_WORK)/pgo.csv
+
+# same code, containers backed by ::operator new instead of Arena
+bench-alloc: $(BENCH).stdalloc $(BENCH).release
+	mkdir -p $(BENCH_WORK)
+	./$(BENCH).stdalloc $(BENCH_ARGS) > $(BENCH_WORK)/stdalloc.csv
+	@echo "== arena vs std::allocator"
+	./$(BENCH).release $(BENCH_ARGS) --compare $(BENCH_WORK)/stdalloc.csv > $(BENCH_WORK)/arena.csv
+
+bench-save: $(BENCH).$(VARIANT)
+	./$(BENCH).$(VARIANT) $(BENCH_ARGS) > $(BENCH_BASELINE)
+
+bench-check: $(BENCH).$(VARIANT)
+	./$(BENCH).$(VARIANT) $(BENCH_ARGS) --baseline $(BENCH_BASELINE) --threshold $(BENCH_THRESHOLD)
+
+bench-clean:
+	rm -rf $(BENCH_WORK) $(BENCH).debug $(BENCH).release $(BENCH).native $(BENCH).lto $(BENCH).pgo $(BENCH).stdalloc $(BENCH).count
+
+.PHONY: bench bench-variants bench-alloc bench-save bench-check bench-clean
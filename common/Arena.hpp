@@ -0,0 +1,258 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <new>
+
+// Bump arena with per-size free lists, plus two allocators that plug it into
+// standard containers:
+//   ArenaAllocator<T>  bump only, deallocate() is a no-op; for containers
+//                      that only grow (set/map filled once, then dropped)
+//   PoolAllocator<T>   recycles blocks of the same size; for containers that
+//                      churn (deque chains growing and being swapped)
+// Everything handed out is released at once by reset() or ~Arena().
+//
+// Building with -DCPP09_STD_ALLOC routes every request to ::operator new so
+// the bench can compare against the global allocator without code changes.
+class Arena {
+    public:
+        explicit Arena(std::size_t chunkSize = 64 * 1024);
+        ~Arena();
+
+        void* allocate(std::size_t bytes);
+        void deallocate(void* p, std::size_t bytes);
+        void* allocateNode(std::size_t bytes);
+        void releaseNode(void* p, std::size_t bytes);
+
+        // Drops every allocation; keeps the current chunk for reuse.
+        void reset();
+
+        std::size_t chunkCount() const;
+
+    private:
+        struct Chunk { Chunk* next; std::size_t size; };
+        enum { kAlign = 16, kClasses = 32 };
+
+        Chunk* _chunks;
+        char* _cur;
+        char* _end;
+        std::size_t _chunkSize;
+        void* _free[kClasses];
+
+        static std::size_t roundUp(std::size_t n);
+        static std::size_t headerSize();
+        static char* dataOf(Chunk* c);
+        Chunk* newChunk(std::size_t size);
+        void clearFreeLists();
+
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+};
+
+// ---------- Arena ----------
+inline Arena::Arena(std::size_t chunkSize)
+    : _chunks(0), _cur(0), _end(0), _chunkSize(roundUp(chunkSize)) {
+    clearFreeLists();
+}
+
+inline Arena::~Arena() {
+    while (_chunks) {
+        Chunk* next = _chunks->next;
+        ::operator delete(_chunks);
+        _chunks = next;
+    }
+}
+
+inline std::size_t Arena::roundUp(std::size_t n) {
+    return (n + kAlign - 1) & ~static_cast<std::size_t>(kAlign - 1);
+}
+
+inline std::size_t Arena::headerSize() { return roundUp(sizeof(Chunk)); }
+
+inline char* Arena::dataOf(Chunk* c) { return reinterpret_cast<char*>(c) + headerSize(); }
+
+inline Arena::Chunk* Arena::newChunk(std::size_t size) {
+    Chunk* c = static_cast<Chunk*>(::operator new(headerSize() + size));
+    c->size = size;
+    return c;
+}
+
+inline void Arena::clearFreeLists() {
+    for (int i = 0; i < kClasses; ++i) _free[i] = 0;
+}
+
+inline void* Arena::allocate(std::size_t bytes) {
+#ifdef CPP09_STD_ALLOC
+    return ::operator new(bytes);
+#else
+    bytes = roundUp(bytes ? bytes : 1);
+    if (bytes > _chunkSize / 4) {
+        // big block: own chunk, linked behind the current one
+        Chunk* c = newChunk(bytes);
+        if (_chunks) {
+            c->next = _chunks->next;
+            _chunks->next = c;
+        } else {
+            c->next = 0;
+            _chunks = c;
+        }
+        return dataOf(c);
+    }
+    if (static_cast<std::size_t>(_end - _cur) < bytes) {
+        Chunk* c = newChunk(_chunkSize);
+        c->next = _chunks;
+        _chunks = c;
+        _cur = dataOf(c);
+        _end = _cur + _chunkSize;
+    }
+    void* p = _cur;
+    _cur += bytes;
+    return p;
+#endif
+}
+
+inline void Arena::deallocate(void* p, std::size_t bytes) {
+    (void)bytes;
+#ifdef CPP09_STD_ALLOC
+    ::operator delete(p);
+#else
+    (void)p;
+#endif
+}
+
+inline void* Arena::allocateNode(std::size_t bytes) {
+#ifdef CPP09_STD_ALLOC
+    return ::operator new(bytes);
+#else
+    std::size_t idx = roundUp(bytes ? bytes : 1) / kAlign - 1;
+    if (idx < kClasses && _free[idx]) {
+        void* p = _free[idx];
+        _free[idx] = *static_cast<void**>(p);
+        return p;
+    }
+    return allocate(bytes);
+#endif
+}
+
+inline void Arena::releaseNode(void* p, std::size_t bytes) {
+#ifdef CPP09_STD_ALLOC
+    (void)bytes;
+    ::operator delete(p);
+#else
+    std::size_t idx = roundUp(bytes ? bytes : 1) / kAlign - 1;
+    if (idx >= kClasses) return; // big blocks wait for reset()
+    *static_cast<void**>(p) = _free[idx];
+    _free[idx] = p;
+#endif
+}
+
+inline void Arena::reset() {
+    clearFreeLists();
+    if (!_chunks) return;
+    // _chunks may be a big block when nothing small was ever allocated
+    Chunk* keep = (_chunks->size == _chunkSize) ? _chunks : 0;
+    Chunk* c = keep ? keep->next : _chunks;
+    while (c) {
+        Chunk* next = c->next;
+        ::operator delete(c);
+        c = next;
+    }
+    _chunks = keep;
+    if (keep) {
+        keep->next = 0;
+        _cur = dataOf(keep);
+        _end = _cur + _chunkSize;
+    } else {
+        _cur = _end = 0;
+    }
+}
+
+inline std::size_t Arena::chunkCount() const {
+    std::size_t n = 0;
+    for (Chunk* c = _chunks; c; c = c->next) ++n;
+    return n;
+}
+
+// ---------- ArenaAllocator ----------
+template <typename T>
+class ArenaAllocator {
+    public:
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T value_type;
+
+        template <typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+        explicit ArenaAllocator(Arena& arena) throw() : _arena(&arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) throw() : _arena(other.arena()) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void* = 0) {
+            return static_cast<pointer>(_arena->allocate(n * sizeof(T)));
+        }
+        void deallocate(pointer p, size_type n) { _arena->deallocate(p, n * sizeof(T)); }
+
+        size_type max_size() const throw() { return size_type(-1) / sizeof(T); }
+        void construct(pointer p, const T& val) { new (static_cast<void*>(p)) T(val); }
+        void destroy(pointer p) { p->~T(); }
+
+        Arena* arena() const throw() { return _arena; }
+
+    private:
+        Arena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() == b.arena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() != b.arena(); }
+
+// ---------- PoolAllocator ----------
+template <typename T>
+class PoolAllocator {
+    public:
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T value_type;
+
+        template <typename U> struct rebind { typedef PoolAllocator<U> other; };
+
+        explicit PoolAllocator(Arena& arena) throw() : _arena(&arena) {}
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>& other) throw() : _arena(other.arena()) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void* = 0) {
+            return static_cast<pointer>(_arena->allocateNode(n * sizeof(T)));
+        }
+        void deallocate(pointer p, size_type n) { _arena->releaseNode(p, n * sizeof(T)); }
+
+        size_type max_size() const throw() { return size_type(-1) / sizeof(T); }
+        void construct(pointer p, const T& val) { new (static_cast<void*>(p)) T(val); }
+        void destroy(pointer p) { p->~T(); }
+
+        Arena* arena() const throw() { return _arena; }
+
+    private:
+        Arena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) { return a.arena() == b.arena(); }
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) { return a.arena() != b.arena(); }
+
+#endif
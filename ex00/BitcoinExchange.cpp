@@ -5,8 +5,31 @@
 #include <cstdlib>
 #include <climits>
 #include <cctype>
+#include <algorithm>
+
+BitcoinExchange::BitcoinExchange()
+    : _rates(std::less<std::string>(), ArenaAllocator<RateEntry>(_arena)), _tableSize(0){}
+
+BitcoinExchange::BitcoinExchange(const BitcoinExchange& other)
+    : _rates(other._rates.begin(), other._rates.end(),
+             std::less<std::string>(), ArenaAllocator<RateEntry>(_arena)),
+      _days(other._days), _values(other._values), _prefix(other._prefix),
+      _sparse(other._sparse), _tableSize(other._tableSize){}
+
+BitcoinExchange& BitcoinExchange::operator=(const BitcoinExchange& other){
+    if (this != &other){
+        _rates.clear();
+        _arena.reset();
+        _rates.insert(other._rates.begin(), other._rates.end());
+        _days = other._days;
+        _values = other._values;
+        _prefix = other._prefix;
+        _sparse = other._sparse;
+        _tableSize = other._tableSize;
+    }
+    return *this;
+}
 
-BitcoinExchange::BitcoinExchange(){}
 BitcoinExchange::~BitcoinExchange(){}
 
 std::string BitcoinExchange::trim(const std::string& s){
@@ -75,7 +98,7 @@ bool BitcoinExchange::isValidDate(const std::string& date){
 }
 
 bool BitcoinExchange::getRateForDate(const std::string& date, double& rate) const {
-    std::map<std::string, double>::const_iterator it = _rates.lower_bound(date);
+    RateMap::const_iterator it = _rates.lower_bound(date);
     if (it != _rates.end() && it->first == date){
         rate = it->second;
         return true;
@@ -122,52 +145,94 @@ void BitcoinExchange::loadCSV(const std::string& path){
         if (!parseDouble(rateStr, rate)) continue;
         _rates[date] = rate;
     }
+    buildRangeIndex();
 }
 
-void BitcoinExchange::processInputFile(const std::string& inputPath) const{
-    std::ifstream in(inputPath.c_str());
+// ---------- Input files ----------
+bool BitcoinExchange::openInput(const std::string& path, std::ifstream& in){
+    in.open(path.c_str());
     if (!in){
         std::cout << "Error: could not open file." << std::endl;
-        return;
+        return false;
     }
-    std::string line;
-    bool first = true;
-    while (std::getline(in, line)){
-        std::string original = line;
-        line = trim(line);
+    return true;
+}
+
+// case- and whitespace-insensitive match, e.g. "Date | Value" vs "date|value"
+bool BitcoinExchange::isHeader(const std::string& line, const std::string& header){
+    std::string lower = line;
+    for (size_t i = 0; i < lower.size(); ++i)
+        lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(lower[i])));
+    std::string noSpaces;
+    for (size_t i = 0; i < lower.size(); ++i){
+        if (!std::isspace(static_cast<unsigned char>(lower[i])))
+            noSpaces += lower[i];
+    }
+    return noSpaces == header;
+}
+
+// Next trimmed line that is not blank, a '#' comment or the header (only
+// accepted as the first such line). `original` keeps the untrimmed text.
+bool BitcoinExchange::nextDataLine(std::istream& in, const std::string& header, bool& first,
+                                   std::string& line, std::string& original){
+    while (std::getline(in, original)){
+        line = trim(original);
         if (line.empty()) continue;
-        if (!line.empty() && line[0] == '#') continue;
+        if (line[0] == '#') continue;
 
-        if(first){
+        if (first){
             first = false;
-            std::string lower = line;
-            for (size_t i = 0; i < lower.size(); ++i)
-                lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(lower[i])));
-            std::string noSpaces;
-            for (size_t i = 0; i < lower.size(); ++i){
-                if (!std::isspace(static_cast<unsigned char>(lower[i])))
-                    noSpaces += lower[i];
-            }
-            if (noSpaces == "date|value") continue;
+            if (isHeader(line, header)) continue;
         }
+        return true;
+    }
+    return false;
+}
 
-        std::string::size_type bar = line.find('|');
+// `fields` is reused across lines so its storage is allocated only once
+void BitcoinExchange::splitFields(const std::string& line, std::vector<std::string>& fields){
+    fields.clear();
+    std::string::size_type start = 0;
+    for (;;){
+        std::string::size_type bar = line.find('|', start);
         if (bar == std::string::npos){
-            std::cout << "Error: bad input => " << original << std::endl;
+            fields.push_back(trim(line.substr(start)));
+            return;
+        }
+        fields.push_back(trim(line.substr(start, bar - start)));
+        start = bar + 1;
+    }
+}
+
+void BitcoinExchange::badInput(const std::string& original){
+    std::cout << "Error: bad input => " << original << std::endl;
+}
+
+void BitcoinExchange::processInputFile(const std::string& inputPath) const{
+    std::ifstream in;
+    if (!openInput(inputPath, in)) return;
+
+    std::string line, original;
+    std::vector<std::string> fields;
+    bool first = true;
+    while (nextDataLine(in, "date|value", first, line, original)){
+        splitFields(line, fields);
+        if (fields.size() != 2){
+            badInput(original);
             continue;
         }
 
-        std::string date = trim(line.substr(0, bar));
-        std::string valueStr = trim(line.substr(bar + 1));
+        const std::string& date = fields[0];
+        const std::string& valueStr = fields[1];
 
         if (!isValidDate(date)){
-            std::cout << "Error: bad input => " << original << std::endl;
+            badInput(original);
             continue;
         }
 
         double value;
         if (!parseDouble(valueStr, value)){
-            std::cout << "Error: bad input => " << original << std::endl;
+            badInput(original);
             continue;
         }
 
@@ -183,11 +248,165 @@ void BitcoinExchange::processInputFile(const std::string& inputPath) const{
 
         double rate;
         if (!getRateForDate(date, rate)){
-            std::cout << "Error: bad input => " << original << std::endl;
+            badInput(original);
             continue;
         }
 
         double result = value * rate;
         std::cout << date << " => " << valueStr << " = " << formatDouble(result) << std::endl;
     }
-}
\ No newline at end of file
+}
+
+// ---------- Range queries ----------
+// days since 1970-01-01 (proleptic Gregorian, negative before it)
+bool BitcoinExchange::dayNumber(const std::string& date, long& out){
+    int y, m, d;
+    if (!isValidDate(date) || !parseYMD(date, y, m, d)) return false;
+    long yy = y - (m <= 2 ? 1 : 0);
+    long era = (yy >= 0 ? yy : yy - 399) / 400; // floor, yy is -1 for 0000-01/02
+    long yoe = yy - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    out = era * 146097 + doe - 719468;
+    return true;
+}
+
+bool BitcoinExchange::parseRangeOp(const std::string& s, RangeOp& op){
+    if (s == "sum") op = RANGE_SUM;
+    else if (s == "avg") op = RANGE_AVG;
+    else if (s == "min") op = RANGE_MIN;
+    else if (s == "max") op = RANGE_MAX;
+    else if (s == "value") op = RANGE_VALUE;
+    else return false;
+    return true;
+}
+
+// levels [0, k) hold n, n - 1, n - 3, ..., n - 2^(k-1) + 1 entries
+size_t BitcoinExchange::levelOffset(size_t n, size_t k){
+    return k * (n + 1) - ((static_cast<size_t>(1) << k) - 1);
+}
+
+void BitcoinExchange::buildRangeIndex(){
+    _days.clear();
+    _values.clear();
+    _days.reserve(_rates.size());
+    _values.reserve(_rates.size());
+    for (RateMap::const_iterator it = _rates.begin(); it != _rates.end(); ++it){
+        long day;
+        dayNumber(it->first, day); // keys passed isValidDate in loadCSV
+        _days.push_back(day);
+        _values.push_back(it->second);
+    }
+    size_t n = _values.size();
+
+    // entry i stands for every day up to the next entry
+    _prefix.assign(n, 0.0);
+    for (size_t i = 1; i < n; ++i)
+        _prefix[i] = _prefix[i - 1] + _values[i - 1] * (_days[i] - _days[i - 1]);
+
+    size_t levels = 0;
+    while ((static_cast<size_t>(1) << levels) <= n) ++levels;
+    _tableSize = levelOffset(n, levels);
+    _sparse.assign(2 * _tableSize, 0.0);
+    double* mins = n ? &_sparse[0] : 0;
+    double* maxs = mins + _tableSize;
+
+    std::copy(_values.begin(), _values.end(), mins);
+    std::copy(_values.begin(), _values.end(), maxs);
+    for (size_t k = 1; k < levels; ++k){
+        size_t half = static_cast<size_t>(1) << (k - 1);
+        size_t len = n - (static_cast<size_t>(1) << k) + 1;
+        size_t prev = levelOffset(n, k - 1);
+        size_t cur = levelOffset(n, k);
+        for (size_t i = 0; i < len; ++i){
+            mins[cur + i] = std::min(mins[prev + i], mins[prev + i + half]);
+            maxs[cur + i] = std::max(maxs[prev + i], maxs[prev + i + half]);
+        }
+    }
+}
+
+// index of the entry whose rate applies on `day`; caller checks day >= _days[0]
+size_t BitcoinExchange::entryFor(long day) const{
+    return std::upper_bound(_days.begin(), _days.end(), day) - _days.begin() - 1;
+}
+
+double BitcoinExchange::rangeExtreme(size_t first, size_t last, bool wantMin) const{
+    size_t len = last - first + 1;
+    size_t k = 0;
+    while ((static_cast<size_t>(2) << k) <= len) ++k;
+    const double* t = &_sparse[(wantMin ? 0 : _tableSize) + levelOffset(_values.size(), k)];
+    double a = t[first];
+    double b = t[last + 1 - (static_cast<size_t>(1) << k)];
+    return wantMin ? std::min(a, b) : std::max(a, b);
+}
+
+bool BitcoinExchange::queryRange(const std::string& start, const std::string& end,
+                                 RangeOp op, double& out, double value) const{
+    long first, last;
+    if (!dayNumber(start, first) || !dayNumber(end, last) || first > last) return false;
+    if (_days.empty() || first < _days[0]) return false;
+
+    size_t a = entryFor(first);
+    size_t b = entryFor(last);
+
+    if (op == RANGE_MIN || op == RANGE_MAX){
+        out = rangeExtreme(a, b, op == RANGE_MIN);
+        return true;
+    }
+
+    double sum;
+    if (a == b)
+        sum = _values[a] * (last - first + 1);
+    else
+        sum = _values[a] * (_days[a + 1] - first)
+            + (_prefix[b] - _prefix[a + 1])
+            + _values[b] * (last - _days[b] + 1);
+    if (op == RANGE_AVG) out = sum / (last - first + 1);
+    else if (op == RANGE_VALUE) out = value * sum;
+    else out = sum;
+    return true;
+}
+
+void BitcoinExchange::processRangeFile(const std::string& inputPath) const{
+    std::ifstream in;
+    if (!openInput(inputPath, in)) return;
+
+    std::string line, original;
+    std::vector<std::string> fields;
+    bool first = true;
+    while (nextDataLine(in, "start|end|op", first, line, original)){
+        // "start | end | op", or "start | end | value | amount"
+        splitFields(line, fields);
+        RangeOp op;
+        if (fields.size() < 3 || !parseRangeOp(fields[2], op)
+            || fields.size() != (op == RANGE_VALUE ? 4u : 3u)){
+            badInput(original);
+            continue;
+        }
+
+        double value = 1.0;
+        if (op == RANGE_VALUE){
+            if (!parseDouble(fields[3], value)){
+                badInput(original);
+                continue;
+            }
+            if (value < 0.0) {
+                std::cout << "Error: not a positive number." <<std::endl;
+                continue;
+            }
+            if (value > 1000.0) {
+                std::cout << "Error: too large a number." <<std::endl;
+                continue;
+            }
+        }
+
+        double result;
+        if (!queryRange(fields[0], fields[1], op, result, value)){
+            badInput(original);
+            continue;
+        }
+        std::cout << fields[0] << " | " << fields[1] << " | " << fields[2];
+        if (op == RANGE_VALUE) std::cout << " | " << fields[3];
+        std::cout << " = " << formatDouble(result) << std::endl;
+    }
+}
@@ -3,17 +3,51 @@
 
 #include <map>
 #include <string>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include "Arena.hpp"
 
 class BitcoinExchange{
     public:
         BitcoinExchange();
+        BitcoinExchange(const BitcoinExchange& other);
+        BitcoinExchange& operator=(const BitcoinExchange& other);
         ~BitcoinExchange();
 
+        enum RangeOp { RANGE_SUM, RANGE_AVG, RANGE_MIN, RANGE_MAX, RANGE_VALUE };
+
         void loadCSV(const std::string& path);
         void processInputFile(const std::string& inputPath) const;
+        void processRangeFile(const std::string& inputPath) const;
+
+        bool getRateForDate(const std::string& date, double& rate) const;
+        // Aggregates the rate of every calendar day in [start, end], each day
+        // taking the closest earlier rate like getRateForDate does.
+        // RANGE_VALUE is the worth of `value` BTC summed over those days,
+        // i.e. value * RANGE_SUM; `value` is ignored by the other ops.
+        bool queryRange(const std::string& start, const std::string& end,
+                        RangeOp op, double& out, double value = 1.0) const;
 
     private:
-        std::map<std::string, double> _rates;
+        typedef std::pair<const std::string, double> RateEntry;
+        typedef std::map<std::string, double, std::less<std::string>,
+                         ArenaAllocator<RateEntry> > RateMap;
+
+        // map nodes live in _arena (declared first: must outlive _rates)
+        Arena _arena;
+        RateMap _rates;
+
+        // Range index over _rates, rebuilt by loadCSV:
+        //   _prefix[i]  sum of rate * days covered for entries [0, i)
+        //   _sparse     sparse tables in one buffer: level k of the min table
+        //               at levelOffset(n, k) holds min over [i, i + 2^k); the
+        //               max table follows at _tableSize with the same layout
+        std::vector<long> _days;
+        std::vector<double> _values;
+        std::vector<double> _prefix;
+        std::vector<double> _sparse;
+        size_t _tableSize;
 
         static std::string trim(const std::string& s);
         static bool isDigits(const std::string& s);
@@ -22,9 +56,22 @@ class BitcoinExchange{
         static bool parseYMD(const std::string& d, int& y, int& m, int& day);        
         static bool isLeap(int y);
         static int daysInMonth(int y, int m);
+        static bool dayNumber(const std::string& date, long& out);
+        static bool parseRangeOp(const std::string& s, RangeOp& op);
 
-        bool getRateForDate(const std::string& date, double& rate) const;
+        static size_t levelOffset(size_t n, size_t k);
+        void buildRangeIndex();
+        size_t entryFor(long day) const;
+        double rangeExtreme(size_t first, size_t last, bool wantMin) const;
         static std::string formatDouble(double x);
+
+        // shared by processInputFile / processRangeFile
+        static bool openInput(const std::string& path, std::ifstream& in);
+        static bool isHeader(const std::string& line, const std::string& header);
+        static bool nextDataLine(std::istream& in, const std::string& header, bool& first,
+                                 std::string& line, std::string& original);
+        static void splitFields(const std::string& line, std::vector<std::string>& fields);
+        static void badInput(const std::string& original);
 };
 
 #endif
@@ -0,0 +1,265 @@
+#include "BitcoinExchange.hpp"
+#include "Bench.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <unistd.h>
+
+// Benchmark driver for btc.
+//
+//   ./btc_bench [--data data.csv] [--lines N] [--ranges N]
+//               <common bench flags, see Bench.hpp>
+//
+// Times loading the rate database and answering the shipped input files,
+// plus a synthetic input of N valid queries spread over the CSV's range.
+// Range aggregates are timed twice: through queryRange's index and through
+// the day-by-day getRateForDate loop it replaces.
+
+static std::string ymd(int y, int m, int d) {
+    std::ostringstream oss;
+    oss << std::setfill('0') << std::setw(4) << y << '-' << std::setw(2) << m
+        << '-' << std::setw(2) << d;
+    return oss.str();
+}
+
+// Writes `lines` queries (2009..2022, values 0..1000) to a temporary file
+// and removes it again when the object goes away.
+class SyntheticInput {
+    public:
+        explicit SyntheticInput(unsigned long lines) {
+            char tmpl[] = "/tmp/btc_benchXXXXXX";
+            int fd = mkstemp(tmpl);
+            if (fd < 0) throw std::runtime_error("could not create temporary input");
+            close(fd);
+            _path = tmpl;
+
+            std::ofstream out(_path.c_str());
+            out << "date | value\n";
+            unsigned int s = 12345;
+            for (unsigned long i = 0; i < lines; ++i) {
+                s = s * 1103515245u + 12345u;
+                int y = 2009 + static_cast<int>((s >> 8) % 14);
+                int m = 1 + static_cast<int>((s >> 12) % 12);
+                int d = 1 + static_cast<int>((s >> 16) % 28);
+                out << ymd(y, m, d) << " | " << (s >> 20) % 1000 << '.' << (s >> 4) % 100 << '\n';
+            }
+        }
+        ~SyntheticInput() { std::remove(_path.c_str()); }
+
+        const std::string& path() const { return _path; }
+
+    private:
+        std::string _path;
+
+        SyntheticInput(const SyntheticInput&);
+        SyntheticInput& operator=(const SyntheticInput&);
+};
+
+// ---------- Cases ----------
+// Each run loads into a fresh object and drops it again, so the release of
+// the rate map is part of the timing.
+class LoadCsv : public bench::Body {
+    public:
+        explicit LoadCsv(const std::string& path) : _path(path) {}
+
+        void run() {
+            BitcoinExchange btc;
+            btc.loadCSV(_path);
+        }
+
+    private:
+        std::string _path;
+};
+
+class ProcessInput : public bench::Body {
+    public:
+        ProcessInput(const BitcoinExchange& btc, const std::string& path)
+            : _btc(btc), _path(path) {}
+
+        void run() {
+            bench::SilenceStdout quiet;
+            _btc.processInputFile(_path);
+        }
+
+    private:
+        const BitcoinExchange& _btc;
+        std::string _path;
+};
+
+// ---------- Range queries ----------
+struct Range {
+    int y, m, d;            // start, for the day-by-day walk
+    std::string start;
+    std::string end;
+};
+
+static void nextDay(int& y, int& m, int& d) {
+    static const int dim[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = ((y % 4 == 0) && (y % 100 != 0)) || (y % 400 == 0);
+    int last = dim[m - 1] + (m == 2 && leap ? 1 : 0);
+    if (++d > last) {
+        d = 1;
+        if (++m > 12) {
+            m = 1;
+            ++y;
+        }
+    }
+}
+
+// spans of 1..1000 days starting between 2009-01-02 and the end of 2021
+static std::vector<Range> makeRanges(unsigned long count) {
+    std::vector<Range> out;
+    unsigned int s = 777;
+    for (unsigned long i = 0; i < count; ++i) {
+        s = s * 1103515245u + 12345u;
+        Range r;
+        r.y = 2009 + static_cast<int>((s >> 8) % 13);
+        r.m = 1 + static_cast<int>((s >> 12) % 12);
+        r.d = 1 + static_cast<int>((s >> 16) % 28);
+        if (r.y == 2009 && r.m == 1 && r.d < 2) r.d = 2;
+        r.start = ymd(r.y, r.m, r.d);
+        int y = r.y, m = r.m, d = r.d;
+        for (int len = static_cast<int>((s >> 4) % 1000); len > 0; --len) nextDay(y, m, d);
+        r.end = ymd(y, m, d);
+        out.push_back(r);
+    }
+    return out;
+}
+
+// BTC amount used by the value-weighted cases
+static const double kHolding = 2.5;
+
+// what callers had to do before queryRange: one point lookup per day
+static double naiveRange(const BitcoinExchange& btc, const Range& r, BitcoinExchange::RangeOp op) {
+    int y = r.y, m = r.m, d = r.d;
+    double sum = 0, lo = 0, hi = 0;
+    long days = 0;
+    for (std::string day = r.start; ; nextDay(y, m, d), day = ymd(y, m, d)) {
+        double rate;
+        if (!btc.getRateForDate(day, rate)) throw std::runtime_error("no rate for " + day);
+        sum += rate;
+        lo = days ? std::min(lo, rate) : rate;
+        hi = days ? std::max(hi, rate) : rate;
+        ++days;
+        if (day == r.end) break;
+    }
+    switch (op) {
+        case BitcoinExchange::RANGE_SUM: return sum;
+        case BitcoinExchange::RANGE_AVG: return sum / days;
+        case BitcoinExchange::RANGE_MIN: return lo;
+        case BitcoinExchange::RANGE_MAX: return hi;
+        case BitcoinExchange::RANGE_VALUE: return kHolding * sum;
+    }
+    return 0;
+}
+
+// Runs every range through either path; teardown() checks the answers
+// against the naive results computed once up front.
+class RangeQueries : public bench::Body {
+    public:
+        RangeQueries(const BitcoinExchange& btc, const std::vector<Range>& ranges,
+                     BitcoinExchange::RangeOp op, bool indexed)
+            : _btc(btc), _ranges(ranges), _op(op), _indexed(indexed) {
+            for (size_t i = 0; i < _ranges.size(); ++i)
+                _expected.push_back(naiveRange(_btc, _ranges[i], _op));
+        }
+
+        void setup() { _got.assign(_ranges.size(), 0.0); }
+        void run() {
+            for (size_t i = 0; i < _ranges.size(); ++i) {
+                if (!_indexed)
+                    _got[i] = naiveRange(_btc, _ranges[i], _op);
+                else if (!_btc.queryRange(_ranges[i].start, _ranges[i].end, _op, _got[i], kHolding))
+                    throw std::runtime_error("queryRange rejected " + _ranges[i].start);
+            }
+        }
+        void teardown() {
+            for (size_t i = 0; i < _ranges.size(); ++i) {
+                double tol = 1e-9 * std::max(1.0, std::fabs(_expected[i]));
+                if (std::fabs(_got[i] - _expected[i]) > tol)
+                    throw std::runtime_error("range mismatch for " + _ranges[i].start + " | " + _ranges[i].end);
+            }
+        }
+
+    private:
+        const BitcoinExchange& _btc;
+        const std::vector<Range>& _ranges;
+        BitcoinExchange::RangeOp _op;
+        bool _indexed;
+        std::vector<double> _expected;
+        std::vector<double> _got;
+};
+
+class BtcBench : public bench::Driver {
+    public:
+        BtcBench() : _data("data.csv"), _lines(100000), _ranges(1000) {}
+
+        const char* name() const { return "btc_bench"; }
+        std::string usage() const { return "[--data file.csv] [--lines N] [--ranges N]"; }
+        bool parseFlag(const std::string& flag, const std::string& val) {
+            if (flag == "--data") _data = val;
+            else if (flag == "--lines") _lines = bench::parseUnsigned(flag, val, 0, 10000000);
+            else if (flag == "--ranges") _ranges = bench::parseUnsigned(flag, val, 0, 1000000);
+            else return false;
+            return true;
+        }
+
+        void run(bench::Reporter& rep, const bench::Options& o) {
+            BitcoinExchange btc;
+            btc.loadCSV(_data);
+            SyntheticInput synthetic(_lines);
+
+            {
+                LoadCsv c(_data);
+                rep.add(bench::measure("loadCSV", c, o));
+            }
+            {
+                ProcessInput c(btc, "input.txt");
+                rep.add(bench::measure("process/input.txt", c, o));
+            }
+            {
+                ProcessInput c(btc, "input_extra.txt");
+                rep.add(bench::measure("process/input_extra.txt", c, o));
+            }
+            {
+                std::ostringstream name;
+                name << "process/synthetic/" << _lines;
+                ProcessInput c(btc, synthetic.path());
+                rep.add(bench::measure(name.str(), c, o));
+            }
+
+            static const char* opNames[] = { "sum", "avg", "min", "max", "value" };
+            static const BitcoinExchange::RangeOp ops[] = {
+                BitcoinExchange::RANGE_SUM, BitcoinExchange::RANGE_AVG,
+                BitcoinExchange::RANGE_MIN, BitcoinExchange::RANGE_MAX,
+                BitcoinExchange::RANGE_VALUE,
+            };
+            std::vector<Range> ranges = makeRanges(_ranges);
+            for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i) {
+                for (int indexed = 1; indexed >= 0; --indexed) {
+                    std::ostringstream name;
+                    name << "range/" << (indexed ? "indexed/" : "naive/") << opNames[i] << '/' << _ranges;
+                    RangeQueries c(btc, ranges, ops[i], indexed != 0);
+                    rep.add(bench::measure(name.str(), c, o));
+                }
+            }
+        }
+
+    private:
+        std::string _data;
+        unsigned long _lines;
+        unsigned long _ranges;
+};
+
+int main(int argc, char** argv) {
+    BtcBench driver;
+    return bench::runMain(driver, argc, argv);
+}
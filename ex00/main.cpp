@@ -1,8 +1,13 @@
 #include "BitcoinExchange.hpp"
 #include <iostream>
+#include <string>
 
+// ./btc <input>            value lookups, "date | value" per line
+// ./btc --range <input>    range aggregates, "start | end | sum|avg|min|max" or
+//                          "start | end | value | amount" per line
 int main(int ac, char **av){
-    if (ac != 2){
+    bool range = (ac == 3 && std::string(av[1]) == "--range");
+    if (ac != 2 && !range){
         std::cout << "Error: could not open file." << std::endl;
         return 1;
     }
@@ -17,6 +22,9 @@ int main(int ac, char **av){
         return 1;
     }
 
-    b.processInputFile(av[1]);
+    if (range)
+        b.processRangeFile(av[2]);
+    else
+        b.processInputFile(av[1]);
     return 0;
 }
\ No newline at end of file
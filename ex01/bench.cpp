@@ -0,0 +1,96 @@
+#include "RPN.hpp"
+#include "Bench.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Benchmark driver for RPN.
+//
+//   ./RPN_bench [--tokens N] <common bench flags, see Bench.hpp>
+//
+// Times the subject's sample expressions and two generated shapes of about
+// N tokens: a flat chain ("1 2 + 3 - 4 + ...") that keeps the stack at two
+// entries, and a deep one ("1 1 1 ... + + +") that grows it to N/2.
+
+// alternating + and - keeps the running value small, so no overflow
+static std::string chainExpr(unsigned long tokens) {
+    std::string s = "1";
+    for (unsigned long i = 1; i + 1 < tokens; i += 2) {
+        s += ' ';
+        s += static_cast<char>('1' + i % 9);
+        s += (i / 2) % 2 ? " -" : " +";
+    }
+    return s;
+}
+
+static std::string deepExpr(unsigned long tokens) {
+    unsigned long operands = (tokens + 1) / 2;
+    std::string s = "1";
+    for (unsigned long i = 1; i < operands; ++i) s += " 1";
+    for (unsigned long i = 1; i < operands; ++i) s += " +";
+    return s;
+}
+
+// ---------- Cases ----------
+class Evaluate : public bench::Body {
+    public:
+        explicit Evaluate(const std::string& expr) : result(0), _expr(expr) {}
+
+        void run() { result = _calc.evaluate(_expr); }
+
+        long result;
+
+    private:
+        std::string _expr;
+        RPN _calc;
+};
+
+static std::string sized(const char* prefix, unsigned long n) {
+    std::ostringstream oss;
+    oss << prefix << n;
+    return oss.str();
+}
+
+static const char* kSamples[] = {
+    "8 9 * 9 - 9 - 9 - 4 - 1 +",
+    "7 7 * 7 -",
+    "1 2 * 2 / 2 * 2 4 - +",
+};
+
+class RpnBench : public bench::Driver {
+    public:
+        RpnBench() : _tokens(100000) {}
+
+        const char* name() const { return "RPN_bench"; }
+        std::string usage() const { return "[--tokens N]"; }
+        bool parseFlag(const std::string& flag, const std::string& val) {
+            if (flag != "--tokens") return false;
+            _tokens = bench::parseUnsigned(flag, val, 3, 10000000);
+            return true;
+        }
+        std::vector<std::string> extraColumns() const { return std::vector<std::string>(1, "result"); }
+
+        void run(bench::Reporter& rep, const bench::Options& o) {
+            for (size_t i = 0; i < sizeof(kSamples) / sizeof(kSamples[0]); ++i)
+                runCase(rep, sized("sample/", i), kSamples[i], o);
+            runCase(rep, sized("chain/", _tokens), chainExpr(_tokens), o);
+            runCase(rep, sized("deep/", _tokens), deepExpr(_tokens), o);
+        }
+
+    private:
+        unsigned long _tokens;
+
+        static void runCase(bench::Reporter& rep, const std::string& name,
+                            const std::string& expr, const bench::Options& o) {
+            Evaluate c(expr);
+            bench::Result r = bench::measure(name, c, o);
+            r.extra.push_back(static_cast<double>(c.result));
+            rep.add(r);
+        }
+};
+
+int main(int argc, char** argv) {
+    RpnBench driver;
+    return bench::runMain(driver, argc, argv);
+}
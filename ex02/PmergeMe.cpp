@@ -5,6 +5,13 @@
 #include <algorithm>
 #include <cctype>
 #include <set>
+#include <functional>
+
+unsigned long PmergeMe::_comparisons = 0;
+
+// ---------- Public: instrumentation ----------
+unsigned long PmergeMe::comparisons() { return _comparisons; }
+void PmergeMe::resetComparisons() { _comparisons = 0; }
 
 // ---------- Public: parsing ----------
 std::vector<int> PmergeMe::parseArgs(int argc, char** argv) {
@@ -12,7 +19,10 @@ std::vector<int> PmergeMe::parseArgs(int argc, char** argv) {
 
     std::vector<int> out;
     out.reserve(argc - 1);
-    std::set<int> seen; // duplicate detection
+    // duplicate detection; nodes come from a local arena freed on return
+    Arena arena;
+    std::less<int> cmp;
+    std::set<int, std::less<int>, ArenaAllocator<int> > seen(cmp, ArenaAllocator<int>(arena));
 
     for (int i = 1; i < argc; ++i) {
         const char* s = argv[i];
@@ -45,6 +55,7 @@ bool PmergeMe::isPositiveInteger(const char* s) {
 // ---------- Public: sort entry points ----------
 void PmergeMe::sortVector(std::vector<int>& v) { fordJohnsonVector(v); }
 void PmergeMe::sortDeque(std::deque<int>& d) { fordJohnsonDeque(d); }
+void PmergeMe::sortDeque(PoolDeque& d) { fordJohnsonDeque(d); }
 
 // ====================== VECTOR VERSION ======================
 void PmergeMe::buildPairsVector(const std::vector<int>& v,
@@ -58,7 +69,7 @@ void PmergeMe::buildPairsVector(const std::vector<int>& v,
     for (size_t i = 0; i < nPairs; ++i) {
         int a = v[2*i], b = v[2*i + 1];
         PairV pr;
-        if (a >= b) { pr.big = a; pr.small = b; }
+        if (!Less()(a, b)) { pr.big = a; pr.small = b; }
         else        { pr.big = b; pr.small = a; }
         pr.used = false;
         pairs.push_back(pr);
@@ -126,8 +137,8 @@ std::vector<size_t> PmergeMe::jacobsthalOrder(size_t n) {
 }
 
 void PmergeMe::boundedInsertVector(std::vector<int>& chain, int value, int boundValue) {
-    std::vector<int>::iterator boundPos = std::lower_bound(chain.begin(), chain.end(), boundValue);
-    std::vector<int>::iterator pos = std::lower_bound(chain.begin(), boundPos, value);
+    std::vector<int>::iterator boundPos = std::lower_bound(chain.begin(), chain.end(), boundValue, Less());
+    std::vector<int>::iterator pos = std::lower_bound(chain.begin(), boundPos, value, Less());
     chain.insert(pos, value);
 }
 
@@ -173,14 +184,15 @@ void PmergeMe::fordJohnsonVector(std::vector<int>& v) {
     std::vector<int> chain;
     insertSmallsVector(chain, pairs);
     if (hasStraggler) {
-        std::vector<int>::iterator pos = std::lower_bound(chain.begin(), chain.end(), straggler);
+        std::vector<int>::iterator pos = std::lower_bound(chain.begin(), chain.end(), straggler, Less());
         chain.insert(pos, straggler);
     }
     v.swap(chain);
 }
 
 // ====================== DEQUE VERSION ======================
-void PmergeMe::buildPairsDeque(const std::deque<int>& d,
+template <typename Chain>
+void PmergeMe::buildPairsDeque(const Chain& d,
                                std::vector<PairD>& pairs,
                                bool& hasStraggler, int& straggler) {
     hasStraggler = (d.size() % 2 != 0);
@@ -191,20 +203,22 @@ void PmergeMe::buildPairsDeque(const std::deque<int>& d,
     for (size_t i = 0; i < nPairs; ++i) {
         int a = d[2*i], b = d[2*i + 1];
         PairD pr;
-        if (a >= b) { pr.big = a; pr.small = b; }
+        if (!Less()(a, b)) { pr.big = a; pr.small = b; }
         else        { pr.big = b; pr.small = a; }
         pr.used = false;
         pairs.push_back(pr);
     }
 }
 
-void PmergeMe::sortBigsDeque(std::vector<PairD>& pairs, std::deque<int>& bigs) {
+template <typename Chain>
+void PmergeMe::sortBigsDeque(std::vector<PairD>& pairs, Chain& bigs) {
     bigs.clear();
     for (size_t i = 0; i < pairs.size(); ++i) bigs.push_back(pairs[i].big);
     fordJohnsonDeque(bigs);
 }
 
-void PmergeMe::reorderPairsByBigsDeque(std::vector<PairD>& pairs, const std::deque<int>& bigs) {
+template <typename Chain>
+void PmergeMe::reorderPairsByBigsDeque(std::vector<PairD>& pairs, const Chain& bigs) {
     std::vector<PairD> ordered;
     ordered.reserve(pairs.size());
     for (size_t i = 0; i < bigs.size(); ++i) {
@@ -221,13 +235,15 @@ void PmergeMe::reorderPairsByBigsDeque(std::vector<PairD>& pairs, const std::deq
     for (size_t i = 0; i < pairs.size(); ++i) pairs[i].used = false;
 }
 
-void PmergeMe::boundedInsertDeque(std::deque<int>& chain, int value, int boundValue) {
-    std::deque<int>::iterator boundPos = std::lower_bound(chain.begin(), chain.end(), boundValue);
-    std::deque<int>::iterator pos = std::lower_bound(chain.begin(), boundPos, value);
+template <typename Chain>
+void PmergeMe::boundedInsertDeque(Chain& chain, int value, int boundValue) {
+    typename Chain::iterator boundPos = std::lower_bound(chain.begin(), chain.end(), boundValue, Less());
+    typename Chain::iterator pos = std::lower_bound(chain.begin(), boundPos, value, Less());
     chain.insert(pos, value);
 }
 
-void PmergeMe::insertSmallsDeque(std::deque<int>& chain, const std::vector<PairD>& pairs) {
+template <typename Chain>
+void PmergeMe::insertSmallsDeque(Chain& chain, const std::vector<PairD>& pairs) {
     if (pairs.empty()) return;
 
     chain.clear();
@@ -256,18 +272,19 @@ void PmergeMe::insertSmallsDeque(std::deque<int>& chain, const std::vector<PairD
 }
 
 
-void PmergeMe::fordJohnsonDeque(std::deque<int>& d) {
+template <typename Chain>
+void PmergeMe::fordJohnsonDeque(Chain& d) {
     if (d.size() <= 1) return;
     std::vector<PairD> pairs;
     bool hasStraggler = false; int straggler = 0;
     buildPairsDeque(d, pairs, hasStraggler, straggler);
-    std::deque<int> bigs;
+    Chain bigs(d.get_allocator());
     sortBigsDeque(pairs, bigs);
     reorderPairsByBigsDeque(pairs, bigs);
-    std::deque<int> chain;
+    Chain chain(d.get_allocator());
     insertSmallsDeque(chain, pairs);
     if (hasStraggler) {
-        std::deque<int>::iterator pos = std::lower_bound(chain.begin(), chain.end(), straggler);
+        typename Chain::iterator pos = std::lower_bound(chain.begin(), chain.end(), straggler, Less());
         chain.insert(pos, straggler);
     }
     d.swap(chain);
@@ -4,13 +4,25 @@
 #include <vector>
 #include <deque>
 #include <string>
+#include "Arena.hpp"
 
 class PmergeMe {
 public:
     static std::vector<int> parseArgs(int argc, char** argv);
 
+    // Deque whose blocks come from a caller-owned Arena; only the bench sorts
+    // one, to compare against the std::allocator path main.cpp uses.
+    typedef std::deque<int, PoolAllocator<int> > PoolDeque;
+
     static void sortVector(std::vector<int>& v);
     static void sortDeque(std::deque<int>& d);
+    static void sortDeque(PoolDeque& d);
+
+    // Element comparisons performed by the sorts since the last reset;
+    // only counted when built with -DCPP09_COUNT_CMP (the bench's count
+    // variant), so every other build runs the plain comparator.
+    static unsigned long comparisons();
+    static void resetComparisons();
 
 private:
     // ----- Vector implementation -----
@@ -26,17 +38,29 @@ private:
     static void boundedInsertVector(std::vector<int>& chain, int value, int boundValue);
 
     // ----- Deque implementation -----
+    // Templated on the chain so either sortDeque() overload sorts in place;
+    // helper chains share the allocator of the deque being sorted.
     struct PairD { int big; int small; bool used; };
-    static void fordJohnsonDeque(std::deque<int>& d);
-    static void buildPairsDeque(const std::deque<int>& d,
-                                std::vector<PairD>& pairs,
-                                bool& hasStraggler, int& straggler);
-    static void sortBigsDeque(std::vector<PairD>& pairs, std::deque<int>& bigs);
-    static void reorderPairsByBigsDeque(std::vector<PairD>& pairs, const std::deque<int>& bigs);
-    static void insertSmallsDeque(std::deque<int>& chain, const std::vector<PairD>& pairs);
-    static void boundedInsertDeque(std::deque<int>& chain, int value, int boundValue);
+    template <typename Chain> static void fordJohnsonDeque(Chain& d);
+    template <typename Chain> static void buildPairsDeque(const Chain& d,
+                                                          std::vector<PairD>& pairs,
+                                                          bool& hasStraggler, int& straggler);
+    template <typename Chain> static void sortBigsDeque(std::vector<PairD>& pairs, Chain& bigs);
+    template <typename Chain> static void reorderPairsByBigsDeque(std::vector<PairD>& pairs, const Chain& bigs);
+    template <typename Chain> static void insertSmallsDeque(Chain& chain, const std::vector<PairD>& pairs);
+    template <typename Chain> static void boundedInsertDeque(Chain& chain, int value, int boundValue);
 
     static bool isPositiveInteger(const char* s);
+
+    static unsigned long _comparisons;
+    struct Less {
+        bool operator()(int a, int b) const {
+#ifdef CPP09_COUNT_CMP
+            ++_comparisons;
+#endif
+            return a < b;
+        }
+    };
 };
 
 #endif
@@ -0,0 +1,347 @@
+#include "PmergeMe.hpp"
+#include "Bench.hpp"
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <climits>
+
+// Benchmark driver for PmergeMe.
+//
+//   ./PmergeMe_bench [--sizes 10,100,...] [--max-size N] [--patterns p,...]
+//                    [--seed S] <common bench flags, see Bench.hpp>
+//
+// Every (pattern, size) dataset is derived from --seed only, so two runs with
+// the same flags sort exactly the same inputs. Datasets are permutations of
+// 1..n because parseArgs rejects duplicates. The comparisons column is only
+// filled by the count variant: make bench VARIANT=count.
+
+static const size_t kSizeLimit = 10000000;
+
+static std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    std::string::size_type start = 0;
+    while (start <= s.size()) {
+        std::string::size_type comma = s.find(',', start);
+        if (comma == std::string::npos) comma = s.size();
+        if (comma > start) out.push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return out;
+}
+
+static bool isPattern(const std::string& p) {
+    return p == "random" || p == "sorted" || p == "reversed"
+        || p == "nearly" || p == "organ";
+}
+
+// ---------- Datasets ----------
+// xorshift32: tiny, seedable and identical on every platform
+class Rng {
+public:
+    explicit Rng(unsigned int seed) : _s(seed ? seed : 0x9e3779b9u) {}
+    unsigned int next() {
+        _s ^= _s << 13;
+        _s ^= _s >> 17;
+        _s ^= _s << 5;
+        return _s;
+    }
+    size_t below(size_t n) { return static_cast<size_t>(next() % n); }
+private:
+    unsigned int _s;
+};
+
+static unsigned int datasetSeed(unsigned int seed, const std::string& pattern, size_t n) {
+    unsigned int h = seed * 2654435761u;
+    for (size_t i = 0; i < pattern.size(); ++i) h = (h ^ static_cast<unsigned char>(pattern[i])) * 16777619u;
+    return h ^ static_cast<unsigned int>(n * 40503u);
+}
+
+static std::vector<int> makeDataset(const std::string& pattern, size_t n, unsigned int seed) {
+    std::vector<int> v(n);
+    Rng rng(datasetSeed(seed, pattern, n));
+
+    if (pattern == "organ") {
+        // 1 3 5 ... 6 4 2: rises to the middle then falls, all values distinct
+        size_t lo = 0, hi = n;
+        for (size_t k = 0; k < n; ++k) {
+            if (k % 2 == 0) v[lo++] = static_cast<int>(k + 1);
+            else            v[--hi] = static_cast<int>(k + 1);
+        }
+        return v;
+    }
+
+    for (size_t i = 0; i < n; ++i) v[i] = static_cast<int>(i + 1);
+    if (pattern == "reversed") {
+        std::reverse(v.begin(), v.end());
+    }
+    else if (pattern == "random") {
+        for (size_t i = n; i > 1; --i) std::swap(v[i - 1], v[rng.below(i)]);
+    }
+    else if (pattern == "nearly") {
+        // ~1% of positions swapped with a close neighbour
+        size_t swaps = n / 100 ? n / 100 : 1;
+        for (size_t k = 0; k < swaps && n > 1; ++k) {
+            size_t i = rng.below(n);
+            size_t j = std::min(n - 1, i + 1 + rng.below(8));
+            std::swap(v[i], v[j]);
+        }
+    }
+    return v;
+}
+
+// ---------- Cases ----------
+// Comparisons are only counted in the count variant (-DCPP09_COUNT_CMP);
+// the timing variants run the uninstrumented comparators.
+#ifdef CPP09_COUNT_CMP
+static unsigned long g_stdComparisons = 0;
+
+struct CountingLess {
+    bool operator()(int a, int b) const {
+        ++g_stdComparisons;
+        return a < b;
+    }
+};
+#endif
+
+template <typename Container>
+static bool isSortedRun(const Container& c, size_t n) {
+    return c.size() == n && std::adjacent_find(c.begin(), c.end(), std::greater_equal<int>()) == c.end();
+}
+
+// Each run builds a fresh container from the input like main.cpp does; the
+// sortedness check happens in teardown(), outside the timed region.
+// `comparisons` covers every run of the last sample; runCase divides it.
+class VectorSort : public bench::Body {
+    public:
+        explicit VectorSort(const std::vector<int>& in) : comparisons(0), _in(in) {}
+        void setup() {
+            PmergeMe::resetComparisons();
+            std::vector<int>().swap(_out);
+        }
+        void run() {
+            _out.assign(_in.begin(), _in.end());
+            PmergeMe::sortVector(_out);
+        }
+        void teardown() {
+            comparisons = PmergeMe::comparisons();
+            if (!isSortedRun(_out, _in.size())) throw std::runtime_error("vector produced an unsorted result");
+        }
+
+        unsigned long comparisons;
+
+    private:
+        const std::vector<int>& _in;
+        std::vector<int> _out;
+};
+
+class DequeSort : public bench::Body {
+    public:
+        explicit DequeSort(const std::vector<int>& in) : comparisons(0), _in(in) {}
+        void setup() {
+            PmergeMe::resetComparisons();
+            std::deque<int>().swap(_out);
+        }
+        void run() {
+            _out.assign(_in.begin(), _in.end());
+            PmergeMe::sortDeque(_out);
+        }
+        void teardown() {
+            comparisons = PmergeMe::comparisons();
+            if (!isSortedRun(_out, _in.size())) throw std::runtime_error("deque produced an unsorted result");
+        }
+
+        unsigned long comparisons;
+
+    private:
+        const std::vector<int>& _in;
+        std::deque<int> _out;
+};
+
+// Same sort on a pool-backed deque. The arena lives as long as the case,
+// so blocks freed by one run are recycled by the next.
+class PoolDequeSort : public bench::Body {
+    public:
+        explicit PoolDequeSort(const std::vector<int>& in)
+            : comparisons(0), _in(in), _out(PoolAllocator<int>(_arena)) {}
+        void setup() {
+            PmergeMe::resetComparisons();
+            PmergeMe::PoolDeque(_out.get_allocator()).swap(_out);
+        }
+        void run() {
+            _out.assign(_in.begin(), _in.end());
+            PmergeMe::sortDeque(_out);
+        }
+        void teardown() {
+            comparisons = PmergeMe::comparisons();
+            if (!isSortedRun(_out, _in.size())) throw std::runtime_error("pool deque produced an unsorted result");
+        }
+
+        unsigned long comparisons;
+
+    private:
+        const std::vector<int>& _in;
+        Arena _arena;
+        PmergeMe::PoolDeque _out;
+};
+
+class StdSort : public bench::Body {
+    public:
+        explicit StdSort(const std::vector<int>& in) : comparisons(0), _in(in) {}
+        void setup() {
+#ifdef CPP09_COUNT_CMP
+            g_stdComparisons = 0;
+#endif
+            std::vector<int>().swap(_out);
+        }
+        void run() {
+            _out.assign(_in.begin(), _in.end());
+#ifdef CPP09_COUNT_CMP
+            std::sort(_out.begin(), _out.end(), CountingLess());
+#else
+            std::sort(_out.begin(), _out.end());
+#endif
+        }
+        void teardown() {
+#ifdef CPP09_COUNT_CMP
+            comparisons = g_stdComparisons;
+#endif
+            if (!isSortedRun(_out, _in.size())) throw std::runtime_error("std::sort produced an unsorted result");
+        }
+
+        unsigned long comparisons;
+
+    private:
+        const std::vector<int>& _in;
+        std::vector<int> _out;
+};
+
+// parseArgs on the dataset rendered as argv, as main.cpp receives it
+class ParseArgs : public bench::Body {
+    public:
+        explicit ParseArgs(const std::vector<int>& in) : _n(in.size()) {
+            _args.push_back("PmergeMe");
+            for (size_t i = 0; i < in.size(); ++i) {
+                std::ostringstream oss;
+                oss << in[i];
+                _args.push_back(oss.str());
+            }
+            for (size_t i = 0; i < _args.size(); ++i)
+                _argv.push_back(const_cast<char*>(_args[i].c_str()));
+        }
+        void run() { _out = PmergeMe::parseArgs(static_cast<int>(_argv.size()), &_argv[0]); }
+        void teardown() {
+            if (_out.size() != _n) throw std::runtime_error("parseArgs lost elements");
+        }
+
+    private:
+        size_t _n;
+        std::vector<std::string> _args;
+        std::vector<char*> _argv;
+        std::vector<int> _out;
+};
+
+static std::string caseName(const char* algo, const std::string& pattern, size_t n) {
+    std::ostringstream oss;
+    oss << algo << '/' << pattern << '/' << n;
+    return oss.str();
+}
+
+template <typename Case>
+static void runCase(bench::Reporter& rep, const char* algo, const std::string& pattern,
+                    const std::vector<int>& input, const bench::Options& o) {
+    Case c(input);
+    bench::Result r = bench::measure(caseName(algo, pattern, input.size()), c, o);
+    r.extra.push_back(static_cast<double>(input.size()));
+#ifdef CPP09_COUNT_CMP
+    r.extra.push_back(static_cast<double>(c.comparisons / r.iterations));
+#else
+    r.extra.push_back(bench::noValue());
+#endif
+    rep.add(r);
+}
+
+// parsing does no sort comparisons, so that column stays empty
+static void runParse(bench::Reporter& rep, const std::string& pattern,
+                     const std::vector<int>& input, const bench::Options& o) {
+    ParseArgs c(input);
+    bench::Result r = bench::measure(caseName("parse", pattern, input.size()), c, o);
+    r.extra.push_back(static_cast<double>(input.size()));
+    r.extra.push_back(bench::noValue());
+    rep.add(r);
+}
+
+class PmergeMeBench : public bench::Driver {
+    public:
+        PmergeMeBench() : _maxSize(10000), _seed(42) {}
+
+        const char* name() const { return "PmergeMe_bench"; }
+        std::string usage() const {
+            return "[--sizes a,b,...] [--max-size N]"
+                   " [--patterns random,sorted,reversed,nearly,organ] [--seed S]";
+        }
+        bool parseFlag(const std::string& flag, const std::string& val) {
+            if (flag == "--sizes") {
+                std::vector<std::string> items = splitList(val);
+                for (size_t k = 0; k < items.size(); ++k)
+                    _sizes.push_back(bench::parseUnsigned(flag, items[k], 1, kSizeLimit));
+            }
+            else if (flag == "--max-size") _maxSize = bench::parseUnsigned(flag, val, 1, kSizeLimit);
+            else if (flag == "--patterns") {
+                _patterns = splitList(val);
+                for (size_t k = 0; k < _patterns.size(); ++k)
+                    if (!isPattern(_patterns[k]))
+                        throw std::runtime_error("unknown pattern " + _patterns[k]);
+            }
+            else if (flag == "--seed") _seed = static_cast<unsigned int>(bench::parseUnsigned(flag, val, 0, UINT_MAX));
+            else return false;
+            return true;
+        }
+        void finishOptions() {
+            // default: decades from 10 up to --max-size
+            if (_sizes.empty())
+                for (size_t n = 10; n <= _maxSize; n *= 10)
+                    _sizes.push_back(n);
+            if (_patterns.empty()) {
+                _patterns.push_back("random");
+                _patterns.push_back("sorted");
+                _patterns.push_back("reversed");
+                _patterns.push_back("nearly");
+                _patterns.push_back("organ");
+            }
+        }
+        std::vector<std::string> extraColumns() const {
+            std::vector<std::string> extra;
+            extra.push_back("size");
+            extra.push_back("comparisons");
+            return extra;
+        }
+
+        void run(bench::Reporter& rep, const bench::Options& o) {
+            for (size_t s = 0; s < _sizes.size(); ++s) {
+                for (size_t p = 0; p < _patterns.size(); ++p) {
+                    std::vector<int> input = makeDataset(_patterns[p], _sizes[s], _seed);
+                    runParse(rep, _patterns[p], input, o);
+                    runCase<VectorSort>(rep, "vector", _patterns[p], input, o);
+                    runCase<DequeSort>(rep, "deque", _patterns[p], input, o);
+                    runCase<PoolDequeSort>(rep, "deque_pool", _patterns[p], input, o);
+                    runCase<StdSort>(rep, "std_sort", _patterns[p], input, o);
+                }
+            }
+        }
+
+    private:
+        std::vector<size_t> _sizes;
+        std::vector<std::string> _patterns;
+        size_t _maxSize;
+        unsigned int _seed;
+};
+
+int main(int argc, char** argv) {
+    PmergeMeBench driver;
+    return bench::runMain(driver, argc, argv);
+}
@@ -3,14 +3,15 @@
 #include <iomanip>
 #include <vector>
 #include <deque>
-#include <sys/time.h>
+#include <time.h>
+#include <cstring>
 #include <algorithm>
 
 
 static double now_us() {
-    struct timeval tv;
-    gettimeofday(&tv, 0);
-    return tv.tv_sec * 1e6 + tv.tv_usec;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
 }
 
 template <typename It>
@@ -24,10 +25,18 @@ static void printRange(const char* prefix, It first, It last) {
 }
 
 int main(int argc, char** argv) {
+    // -q / --quiet: skip the Before/After listings, keep the timings
+    bool quiet = false;
+    if (argc > 1 && (!std::strcmp(argv[1], "-q") || !std::strcmp(argv[1], "--quiet"))) {
+        quiet = true;
+        --argc;
+        ++argv;
+    }
+
     try {
         std::vector<int> input = PmergeMe::parseArgs(argc, argv);
 
-        printRange("Before: ", input.begin(), input.end());
+        if (!quiet) printRange("Before: ", input.begin(), input.end());
 
         // Vector timing (includes data management)
         double t0v = now_us();
@@ -46,7 +55,7 @@ int main(int argc, char** argv) {
             return 1;
         }
 
-        printRange("After:  ", v.begin(), v.end());
+        if (!quiet) printRange("After:  ", v.begin(), v.end());
 
         std::cout.setf(std::ios::fixed);
         std::cout << std::setprecision(5);